@@ -38,6 +38,17 @@
 
 #include "Adafruit_TMP117.h"
 
+// Conversion cycle time in 0.5 ms units, indexed by CONV then AVG
+static const uint16_t cycle_half_ms[8][4] = {
+    {31, 250, 1000, 2000},         // CONV 0
+    {250, 250, 1000, 2000},        // CONV 1
+    {500, 500, 1000, 2000},        // CONV 2
+    {1000, 1000, 1000, 2000},      // CONV 3
+    {2000, 2000, 2000, 2000},      // CONV 4
+    {8000, 8000, 8000, 8000},      // CONV 5
+    {16000, 16000, 16000, 16000},  // CONV 6
+    {32000, 32000, 32000, 32000}}; // CONV 7
+
 /**
  * @brief Construct a new Adafruit_TMP117::Adafruit_TMP117 object
  *
@@ -116,6 +127,15 @@ void Adafruit_TMP117::reset(void) {
 
   sw_reset.write(1);
   delay(2); // datasheet specifies 2ms for reset
+
+  // the reset reloads the settings from EEPROM, which may not be the
+  // factory defaults
+  uint8_t buffer[2];
+  config_reg->read(buffer, 2);
+  uint16_t config = buffer[0] << 8 | buffer[1];
+  storeAlertsDRDY(config >> 13);
+  cacheSettings(config);
+  startSchedule();
   waitForData();
 }
 
@@ -143,6 +163,11 @@ bool Adafruit_TMP117::getEvent(sensors_event_t *temp) {
   temp->type = SENSOR_TYPE_AMBIENT_TEMPERATURE;
   temp->timestamp = t;
   temp->temperature = (unscaled_temp * TMP117_RESOLUTION);
+
+  if (_new_data) {
+    _new_data = false;
+    updateEstimator(_drdy_time, temp->temperature);
+  }
   return true;
 }
 
@@ -168,6 +193,97 @@ bool Adafruit_TMP117::getAlerts(tmp117_alerts_t *alerts) {
   return true;
 }
 
+/**
+ * @brief Get the I2C address of the sensor
+ *
+ * @return uint8_t The 7-bit I2C address given to `begin`
+ */
+uint8_t Adafruit_TMP117::getAddress(void) { return i2c_dev->address(); }
+
+/**
+ * @brief Read the SMBus Alert Response Address to find which device on the
+ * bus is asserting a shared ALERT line
+ *
+ * When several sensors share one wired-OR ALERT line, a single read from the
+ * Alert Response Address (0x0C) returns the address of the alerting device.
+ * If more than one device is alerting, the one with the lowest address wins
+ * arbitration and releases its ALERT pin; call again until this returns false
+ * to find the rest.
+ *
+ * **NOTE:** Sensors only respond while their ALERT pin is in alert mode and
+ * asserted.
+ *
+ * @param address Pointer to be filled with the 7-bit address of the alerting
+ * device
+ * @param high_alert Pointer to be filled with the alert direction: true if
+ * the temperature is at or above the high threshold, false if it is below the
+ * low threshold
+ * @param wire The Wire object the sensors are connected to
+ * @return true: a device responded false: no device is alerting
+ */
+bool Adafruit_TMP117::readAlertResponse(uint8_t *address, bool *high_alert,
+                                        TwoWire *wire) {
+  // no begin(): it would re-init the bus and undo any Wire.setClock()
+  Adafruit_I2CDevice ara_dev =
+      Adafruit_I2CDevice(TMP117_SMBUS_ALERT_RESPONSE, wire);
+  uint8_t response = 0;
+
+  if (!ara_dev.read(&response, 1)) {
+    return false;
+  }
+  // the 7 MSBs hold the responding address, the LSB the alert direction
+  *address = response >> 1;
+  *high_alert = response & 0x1;
+  return true;
+}
+
+/**
+ * @brief Find the sensor asserting a shared ALERT line and which alert it is
+ *
+ * Uses `readAlertResponse` to identify the alerting sensor and the alert
+ * direction with one bus transaction. No sensor's config register is read, so
+ * the flags of all sensors are left untouched.
+ *
+ * The response releases the responding device's ALERT pin even if it is not
+ * one of `sensors`, so its address and alert direction are still returned.
+ * Call repeatedly until this returns false to handle every device that is
+ * asserting the line.
+ *
+ * @param sensors Array of pointers to initialized sensors sharing the line
+ * @param count The number of sensors in `sensors`
+ * @param alerting Pointer to be set to the alerting sensor, or NULL if the
+ * device that responded is not in `sensors`
+ * @param address Pointer to be filled with the 7-bit address of the device
+ * that responded
+ * @param alerts Pointer to an alerts struct to be filled with the alert
+ * direction of the device that responded. `data_ready` is always false.
+ * @param wire The Wire object the sensors are connected to
+ * @return true: a device responded false: no device is alerting
+ */
+bool Adafruit_TMP117::getAlertingSensor(Adafruit_TMP117 *sensors[],
+                                        uint8_t count,
+                                        Adafruit_TMP117 **alerting,
+                                        uint8_t *address,
+                                        tmp117_alerts_t *alerts,
+                                        TwoWire *wire) {
+  bool high_alert;
+  if (!readAlertResponse(address, &high_alert, wire)) {
+    return false;
+  }
+  memset(alerts, 0, sizeof(tmp117_alerts_t));
+  alerts->high = high_alert;
+  alerts->low = !high_alert;
+
+  *alerting = NULL;
+  for (uint8_t i = 0; i < count; i++) {
+    if (sensors[i]->getAddress() == *address) {
+      *alerting = sensors[i];
+      break;
+    }
+  }
+  return true;
+}
+
 /**
  * @brief Read the current low temperature threshold
  *
@@ -341,7 +457,12 @@ tmp117_average_count_t Adafruit_TMP117::getAveragedSampleCount(void) {
 bool Adafruit_TMP117::setAveragedSampleCount(tmp117_average_count_t count) {
   Adafruit_BusIO_RegisterBits average_count_bits =
       Adafruit_BusIO_RegisterBits(config_reg, 2, 5);
-  return average_count_bits.write(count);
+  if (!average_count_bits.write(count)) {
+    return false;
+  }
+  _average_count = count;
+  startSchedule();
+  return true;
 }
 /**
  * @brief Get current setting for the minimum delay between calculated
@@ -367,7 +488,12 @@ tmp117_delay_t Adafruit_TMP117::getReadDelay(void) {
 bool Adafruit_TMP117::setReadDelay(tmp117_delay_t delay) {
   Adafruit_BusIO_RegisterBits read_delay_bits =
       Adafruit_BusIO_RegisterBits(config_reg, 3, 7);
-  return read_delay_bits.write(delay);
+  if (!read_delay_bits.write(delay)) {
+    return false;
+  }
+  _read_delay = delay;
+  startSchedule();
+  return true;
 }
 
 /**
@@ -392,7 +518,12 @@ tmp117_mode_t Adafruit_TMP117::getMeasurementMode(void) {
 bool Adafruit_TMP117::setMeasurementMode(tmp117_mode_t mode) {
   Adafruit_BusIO_RegisterBits mode_bits =
       Adafruit_BusIO_RegisterBits(config_reg, 2, 10);
-  return mode_bits.write(mode);
+  if (!mode_bits.write(mode)) {
+    return false;
+  }
+  _mode = mode;
+  startSchedule();
+  return true;
 }
 ///////////////////  Misc methods //////////////////////////////
 void Adafruit_TMP117::waitForData(void) {
@@ -412,11 +543,361 @@ bool Adafruit_TMP117::dataReady(void) {
   return alert_drdy_flags.data_ready;
 }
 
+/**
+ * @brief Save the writable registers so they can be restored later
+ *
+ * @param state Pointer to a `tmp117_state_t` to be filled with the current
+ * config, high and low limits and offset
+ * @return true:success false:failure
+ */
+bool Adafruit_TMP117::saveState(tmp117_state_t *state) {
+  Adafruit_BusIO_Register high_limit_reg =
+      Adafruit_BusIO_Register(i2c_dev, TMP117_T_HIGH_LIMIT, 2, MSBFIRST);
+  Adafruit_BusIO_Register low_limit_reg =
+      Adafruit_BusIO_Register(i2c_dev, TMP117_T_LOW_LIMIT, 2, MSBFIRST);
+  Adafruit_BusIO_Register temp_offset_reg =
+      Adafruit_BusIO_Register(i2c_dev, TMP117_TEMP_OFFSET, 2, MSBFIRST);
+  uint8_t buffer[2];
+
+  // reading config clears the alert and data ready flags, so keep them
+  if (!config_reg->read(buffer, 2)) {
+    return false;
+  }
+  uint16_t config = buffer[0] << 8 | buffer[1];
+  storeAlertsDRDY(config >> 13);
+  state->config = config & TMP117_CONFIG_WRITABLE;
+
+  if (!high_limit_reg.read(buffer, 2)) {
+    return false;
+  }
+  state->high_limit = buffer[0] << 8 | buffer[1];
+
+  if (!low_limit_reg.read(buffer, 2)) {
+    return false;
+  }
+  state->low_limit = buffer[0] << 8 | buffer[1];
+
+  if (!temp_offset_reg.read(buffer, 2)) {
+    return false;
+  }
+  state->offset = buffer[0] << 8 | buffer[1];
+  return true;
+}
+
+/**
+ * @brief Write back registers saved with `saveState`
+ *
+ * The current register values are read once and only the registers that
+ * differ from `state` are written. The config register is written last so
+ * that a restored one-shot or continuous mode starts with the restored limits
+ * and offset in place. The conversion schedule used by `nextSampleAt` is
+ * restarted either way.
+ *
+ * @param state Pointer to the `tmp117_state_t` to restore
+ * @return true:success false:failure
+ */
+bool Adafruit_TMP117::restoreState(const tmp117_state_t *state) {
+  tmp117_state_t current;
+  if (!saveState(&current)) {
+    return false;
+  }
+
+  if (current.high_limit != state->high_limit) {
+    Adafruit_BusIO_Register high_limit_reg =
+        Adafruit_BusIO_Register(i2c_dev, TMP117_T_HIGH_LIMIT, 2, MSBFIRST);
+    if (!high_limit_reg.write(state->high_limit)) {
+      return false;
+    }
+  }
+  if (current.low_limit != state->low_limit) {
+    Adafruit_BusIO_Register low_limit_reg =
+        Adafruit_BusIO_Register(i2c_dev, TMP117_T_LOW_LIMIT, 2, MSBFIRST);
+    if (!low_limit_reg.write(state->low_limit)) {
+      return false;
+    }
+  }
+  if (current.offset != state->offset) {
+    Adafruit_BusIO_Register temp_offset_reg =
+        Adafruit_BusIO_Register(i2c_dev, TMP117_TEMP_OFFSET, 2, MSBFIRST);
+    if (!temp_offset_reg.write(state->offset)) {
+      return false;
+    }
+  }
+  if (current.config != (state->config & TMP117_CONFIG_WRITABLE)) {
+    if (!config_reg->write(state->config & TMP117_CONFIG_WRITABLE)) {
+      return false;
+    }
+  }
+  // the cached settings may predate a power cycle, so resync them even if
+  // the config already matched
+  cacheSettings(state->config);
+  startSchedule();
+  return true;
+}
+
+/**
+ * @brief Check that the writable registers match a saved state
+ *
+ * @param state Pointer to the `tmp117_state_t` to compare against
+ * @return true: all registers match false: a register differs or the read
+ * failed
+ */
+bool Adafruit_TMP117::verifyState(const tmp117_state_t *state) {
+  tmp117_state_t current;
+  if (!saveState(&current)) {
+    return false;
+  }
+  return (current.config == (state->config & TMP117_CONFIG_WRITABLE)) &&
+         (current.high_limit == state->high_limit) &&
+         (current.low_limit == state->low_limit) &&
+         (current.offset == state->offset);
+}
+
+/**
+ * @brief Get the time between new measurements for the current settings
+ *
+ * The period is looked up from the datasheet's conversion cycle time table
+ * using the averaged sample count and read delay, then scaled by the drift
+ * correction tracked from new data and measured by `calibrateCycleTime`.
+ *
+ * @return uint32_t The conversion cycle time in microseconds
+ */
+uint32_t Adafruit_TMP117::getCycleTime(void) {
+  return nominalCycleTime(false) * _osc_scale + 0.5;
+}
+
+/**
+ * @brief Predict when the next new measurement will be available
+ *
+ * The prediction is based on the phase of the last data ready flag seen by
+ * `dataReady`, `getAlerts` or `getEvent`, or on the last change of the
+ * measurement settings. In `TMP117_MODE_CONTINUOUS` a conversion is always
+ * due; in `TMP117_MODE_ONE_SHOT` only the pending measurement is predicted.
+ *
+ * @return uint32_t The `micros()` timestamp at which new data is expected.
+ * The conversion following the last one seen stays in the past until it is
+ * read or a further cycle has passed; after that the prediction moves on by
+ * whole cycles to the next conversion. If no conversion is pending, the time
+ * of the last one is returned.
+ */
+uint32_t Adafruit_TMP117::nextSampleAt(void) {
+  if (_mode == TMP117_MODE_SHUTDOWN) {
+    return _sample_anchor;
+  }
+  // after a settings change the first result arrives once averaging is done
+  uint32_t first_us = nominalCycleTime(!_anchor_is_drdy) * _osc_scale + 0.5;
+  uint32_t cycle_us = getCycleTime();
+  uint32_t elapsed_us = micros() - _sample_anchor;
+
+  if ((_mode == TMP117_MODE_ONE_SHOT) || (elapsed_us < first_us + cycle_us)) {
+    return _sample_anchor + first_us;
+  }
+  // conversions were missed; skip to the next one still to come
+  uint32_t missed = (elapsed_us - first_us) / cycle_us;
+  return _sample_anchor + first_us + (missed + 1) * cycle_us;
+}
+
+/**
+ * @brief Get the time remaining until the next new measurement is expected
+ *
+ * Sleeping for this long before calling `getEvent` gives one read per
+ * conversion without polling `dataReady` over the bus.
+ *
+ * @return uint32_t Milliseconds until new data is expected, rounded up, 0 if
+ * it is already due, or `TMP117_NO_SAMPLE_PENDING` if the sensor is shut down
+ */
+uint32_t Adafruit_TMP117::msUntilNextSample(void) {
+  if (_mode == TMP117_MODE_SHUTDOWN) {
+    return TMP117_NO_SAMPLE_PENDING;
+  }
+  int32_t remaining_us = (int32_t)(nextSampleAt() - micros());
+  return remaining_us > 0 ? (remaining_us + 999) / 1000 : 0;
+}
+
+/**
+ * @brief Measure the sensor's conversion period to correct for drift of its
+ * internal oscillator
+ *
+ * Blocks while timing whole conversions over at least `span_ms`, so with long
+ * read delays this can take some time. The data ready flag is polled every
+ * millisecond and each conversion is timed from the middle of the poll
+ * interval in which it was seen. The measured correction is kept when the
+ * averaging or delay settings change. Drift is also tracked continuously as
+ * new data is read, so this only speeds up locking onto the sensor's clock.
+ *
+ * @param span_ms The minimum time to measure over. Longer spans give a more
+ * precise result.
+ * @return true:success false: not in `TMP117_MODE_CONTINUOUS`, timed out, the
+ * measurement was less precise than `TMP117_CALIBRATION_MAX_PPM` or the
+ * measured period is more than 10% off the datasheet value
+ */
+bool Adafruit_TMP117::calibrateCycleTime(uint32_t span_ms) {
+  if (_mode != TMP117_MODE_CONTINUOUS) {
+    return false;
+  }
+  uint32_t nominal_us = nominalCycleTime(false);
+  uint32_t timeout_us = 2 * nominal_us;
+  uint32_t start_us = 0, start_width_us = 0;
+  uint32_t edge_us = 0, edge_width_us = 0;
+  uint32_t cycles = 0;
+
+  dataReady(); // clear any stale flag so the first edge is a fresh one
+  do {
+    uint32_t wait_start = micros();
+    uint32_t miss_us = wait_start; // last poll that didn't see the flag
+    uint32_t poll_us = wait_start;
+    while (!dataReady()) {
+      if ((poll_us - wait_start) > timeout_us) {
+        return false;
+      }
+      miss_us = poll_us;
+      delay(1); // lets background tasks and watchdogs run
+      poll_us = micros();
+    }
+    edge_width_us = poll_us - miss_us;
+    edge_us = miss_us + edge_width_us / 2;
+    if (start_width_us == 0) {
+      start_us = edge_us;
+      start_width_us = edge_width_us + 1; // non-zero marks the start as taken
+    } else {
+      cycles++;
+    }
+  } while ((cycles == 0) || ((edge_us - start_us) < span_ms * 1000));
+
+  // each edge is known to within half of the poll interval it was seen in
+  uint32_t elapsed_us = edge_us - start_us;
+  float error_ppm = (start_width_us + edge_width_us) / 2 * 1e6 / elapsed_us;
+  if (error_ppm > TMP117_CALIBRATION_MAX_PPM) {
+    return false;
+  }
+  float scale = (float)elapsed_us / cycles / nominal_us;
+  if ((scale < 0.9) || (scale > 1.1)) {
+    return false;
+  }
+  _osc_scale = scale;
+  return true;
+}
+
+/**
+ * @brief Estimate the temperature at any time from the readings returned by
+ * `getEvent`, without accessing the sensor
+ *
+ * An alpha-beta tracker is updated with each new reading fetched by
+ * `getEvent` and evaluated here in constant time, so it can be called from
+ * control loops that run much faster than the sensor's conversion rate.
+ * The estimate is the filtered temperature at the last reading moved along
+ * the tracked slope to `at`, forwards or backwards in time; earlier readings
+ * only contribute through the filter state.
+ *
+ * @param at The `micros()` timestamp to estimate the temperature for, the
+ * same time base as `nextSampleAt`
+ * @param estimate Pointer to a `tmp117_estimate_t` to be filled with the
+ * temperature, slope and expected error. The error grows with the distance
+ * from the last reading.
+ * @return true:success false: fewer than `TMP117_ESTIMATOR_MIN_READINGS` new
+ * readings have been fetched, so there is no residual history for the bound
+ */
+bool Adafruit_TMP117::getEstimate(uint32_t at, tmp117_estimate_t *estimate) {
+  if (_est_samples < TMP117_ESTIMATOR_MIN_READINGS) {
+    return false;
+  }
+  int32_t dt_us = (int32_t)(at - _est_time);
+  float horizon = 1.0;
+  if (_est_interval > 0) {
+    horizon += (float)abs(dt_us) / _est_interval;
+  }
+
+  estimate->temperature = _est_temperature + _est_slope * dt_us / 1e6;
+  estimate->slope = _est_slope;
+  estimate->bound = (_est_error + TMP117_RESOLUTION / 2) * horizon;
+  return true;
+}
+
+/**
+ * @brief Set the gains of the estimator used by `getEstimate`
+ *
+ * Higher gains follow changes faster but pass more noise. For a critically
+ * damped response pick `theta` between 0 and 1 and use
+ * `alpha = 1 - theta * theta` and `beta = (1 - theta) * (1 - theta)`; for
+ * example `alpha = 0.5` gives `beta` of about 0.086.
+ *
+ * @param alpha Temperature gain, between 0 and 1
+ * @param beta Slope gain, between 0 and 1
+ */
+void Adafruit_TMP117::setEstimatorGains(float alpha, float beta) {
+  _est_alpha = alpha;
+  _est_beta = beta;
+}
+
+/**
+ * @brief Discard the readings used by `getEstimate`, for example after a
+ * step change that the tracked slope should not follow
+ *
+ */
+void Adafruit_TMP117::resetEstimator(void) {
+  _est_samples = 0;
+  _est_interval = 0;
+  _est_slope = 0;
+  _est_error = 0;
+}
+
+void Adafruit_TMP117::updateEstimator(uint32_t t, float temperature) {
+  uint32_t dt_us = t - _est_time;
+
+  if ((_est_samples > 0) && (dt_us == 0)) {
+    return;
+  }
+  if (_est_samples == 0) {
+    _est_temperature = temperature;
+  } else if (_est_samples == 1) {
+    // seed the slope from the first two readings; quantisation makes it
+    // uncertain by about one LSB over the interval
+    _est_slope = (temperature - _est_temperature) * 1e6 / dt_us;
+    _est_temperature = temperature;
+    _est_error = TMP117_RESOLUTION;
+  } else {
+    float predicted = _est_temperature + _est_slope * dt_us / 1e6;
+    float residual = temperature - predicted;
+
+    _est_temperature = predicted + _est_alpha * residual;
+    _est_slope += _est_beta * residual * 1e6 / dt_us;
+    _est_error += (fabs(residual) - _est_error) / 8;
+  }
+  if (_est_samples < TMP117_ESTIMATOR_MIN_READINGS) {
+    _est_samples++;
+  }
+  if (_est_samples > 1) {
+    _est_interval = dt_us;
+  }
+  _est_time = t;
+}
+
+uint32_t Adafruit_TMP117::nominalCycleTime(bool active_only) {
+  uint8_t conv = active_only ? 0 : _read_delay;
+  return cycle_half_ms[conv][_average_count] * 500UL;
+}
+
+void Adafruit_TMP117::cacheSettings(uint16_t config) {
+  _average_count = (tmp117_average_count_t)((config >> 5) & 0x3);
+  _read_delay = (tmp117_delay_t)((config >> 7) & 0x7);
+  _mode = (tmp117_mode_t)((config >> 10) & 0x3);
+  if (_mode == 2) { // 0x2 is a duplicate CONTINUOUS
+    _mode = TMP117_MODE_CONTINUOUS;
+  }
+}
+
+void Adafruit_TMP117::startSchedule(void) {
+  _sample_anchor = micros();
+  _anchor_is_drdy = false;
+}
+
 void Adafruit_TMP117::readAlertsDRDY(void) {
   Adafruit_BusIO_RegisterBits alert_drdy_bits =
       Adafruit_BusIO_RegisterBits(config_reg, 3, 13);
-  uint8_t alert_bits = alert_drdy_bits.read();
+  storeAlertsDRDY(alert_drdy_bits.read());
+}
 
+void Adafruit_TMP117::storeAlertsDRDY(uint8_t alert_bits) {
   alert_drdy_flags.data_ready = (alert_bits & DRDY_ALRT_FLAG) > 0;
 
   // drdy means a new read finished, verifies that the alert values
@@ -424,5 +905,70 @@ void Adafruit_TMP117::readAlertsDRDY(void) {
   if (alert_drdy_flags.data_ready) {
     alert_drdy_flags.high = (alert_bits & HIGH_ALRT_FLAG) > 0;
     alert_drdy_flags.low = (alert_bits & LOW_ALRT_FLAG) > 0;
+
+    _new_data = true;
+    trackSample(micros());
+    _drdy_time = _sample_anchor;
+    if (_mode == TMP117_MODE_ONE_SHOT) {
+      _mode = TMP117_MODE_SHUTDOWN; // sensor shuts down after one-shot
+    }
+  } else {
+    _last_miss = micros();
+  }
+}
+
+void Adafruit_TMP117::trackSample(uint32_t seen_us) {
+  uint32_t elapsed_us = seen_us - _sample_anchor;
+  // if a poll since the last conversion missed the flag, the new conversion
+  // finished between that poll and this one
+  bool bracketed = ((int32_t)(_last_miss - _sample_anchor) > 0) &&
+                   ((int32_t)(seen_us - _last_miss) >= 0);
+  uint32_t earliest_us = bracketed ? _last_miss : _sample_anchor;
+  uint32_t middle_us = earliest_us + (seen_us - earliest_us) / 2;
+
+  if (!_anchor_is_drdy || (_mode != TMP117_MODE_CONTINUOUS) ||
+      (elapsed_us > 0x7FFFFFFF)) {
+    // nothing to lock onto yet, or the phase is too old to trust
+    _sample_anchor = bracketed ? middle_us : seen_us;
+    _anchor_is_drdy = true;
+    return;
+  }
+
+  uint32_t cycle_us = getCycleTime();
+  uint32_t cycles = (elapsed_us + cycle_us / 2) / cycle_us;
+  if (cycles == 0) {
+    _sample_anchor = bracketed ? middle_us : seen_us;
+    return;
+  }
+  uint32_t expected_us = _sample_anchor + cycles * cycle_us;
+
+  // A phase-locked loop keeps the prediction on the sensor's own clock:
+  // polling latency doesn't move the phase and period drift is corrected
+  int32_t error_us;
+  if (bracketed) {
+    error_us = (int32_t)(middle_us - expected_us);
+  } else if ((int32_t)(seen_us - expected_us) < 0) {
+    error_us = (int32_t)(seen_us - expected_us); // came early
+  } else {
+    // the flag was already set at the first poll, so the conversion may
+    // have come early; lean earlier until a poll sees it arrive
+    error_us = -(int32_t)(cycle_us / TMP117_PLL_STEP_DIVISOR);
+  }
+  if ((uint32_t)abs(error_us) > cycle_us / 2) {
+    _sample_anchor = bracketed ? middle_us : seen_us; // lost lock
+    return;
+  }
+
+  _sample_anchor = expected_us + error_us / 2;
+  _osc_scale += (float)error_us / 8 / cycles / nominalCycleTime(false);
+  _osc_scale = constrain(_osc_scale, 0.9, 1.1);
+
+  // never predict a conversion before a poll that didn't see it, or after
+  // the poll that did
+  if (bracketed && ((int32_t)(_sample_anchor - earliest_us) < 0)) {
+    _sample_anchor = earliest_us;
+  }
+  if ((int32_t)(_sample_anchor - seen_us) > 0) {
+    _sample_anchor = seen_us;
   }
 }
@@ -37,10 +37,25 @@
 #define TMP117_DEVICE_ID 0x0F     ///< Device ID register
 #define WHOAMI_ANSWER 0x0117      ///< Correct 2-byte ID register value response
 
+#define TMP117_SMBUS_ALERT_RESPONSE 0x0C ///< SMBus Alert Response Address
+
 #define HIGH_ALRT_FLAG 0b100 ///< mask to check high threshold alert
 #define LOW_ALRT_FLAG 0b010  ///< mask to check low threshold alert
 #define DRDY_ALRT_FLAG 0b001 ///< mask to check data ready flag
 
+#define TMP117_CONFIG_WRITABLE 0x0FFC ///< config bits restored by restoreState
+
+#define TMP117_NO_SAMPLE_PENDING                                               \
+  0xFFFFFFFF ///< msUntilNextSample value when no conversion is scheduled
+
+#define TMP117_ESTIMATOR_MIN_READINGS                                          \
+  3 ///< Readings needed before getEstimate returns a result
+
+#define TMP117_CALIBRATION_MAX_PPM                                             \
+  1000 ///< Worst precision accepted by calibrateCycleTime, in ppm
+#define TMP117_PLL_STEP_DIVISOR                                                \
+  256 ///< Fraction of a cycle the schedule leans early when it can't tell
+
 #define TMP117_RESOLUTION                                                      \
   0.0078125f ///< Scalar to convert from LSB value to degrees C
 
@@ -72,6 +87,30 @@ typedef struct {
   bool data_ready; ///< Status of the data_ready alert
 } tmp117_alerts_t;
 
+/**
+ * @brief A struct to hold a snapshot of the writable registers
+ *
+ * Filled by `saveState` and written back by `restoreState`, for example after
+ * the sensor has been power cycled. Values are raw register contents.
+ *
+ */
+typedef struct {
+  uint16_t config;     ///< Configuration register, writable bits only
+  uint16_t high_limit; ///< High limit set point register
+  uint16_t low_limit;  ///< Low limit set point register
+  uint16_t offset;     ///< Temp offset register
+} tmp117_state_t;
+
+/**
+ * @brief A struct to hold a temperature estimate from `getEstimate`
+ *
+ */
+typedef struct {
+  float temperature; ///< Estimated temperature in degrees C
+  float slope;       ///< Estimated rate of change in degrees C per second
+  float bound;       ///< Expected error of `temperature` in degrees C
+} tmp117_estimate_t;
+
 /**
  * @brief Options for setAveragedSampleCount
  *
@@ -146,6 +185,14 @@ public:
   bool getEvent(sensors_event_t *temp);
   bool getAlerts(tmp117_alerts_t *alerts);
 
+  uint8_t getAddress(void);
+  static bool readAlertResponse(uint8_t *address, bool *high_alert,
+                                TwoWire *wire = &Wire);
+  static bool getAlertingSensor(Adafruit_TMP117 *sensors[], uint8_t count,
+                                Adafruit_TMP117 **alerting, uint8_t *address,
+                                tmp117_alerts_t *alerts,
+                                TwoWire *wire = &Wire);
+
   bool thermAlertModeEnabled(bool therm_enabled);
   bool thermAlertModeEnabled(void);
 
@@ -169,6 +216,19 @@ public:
 
   bool dataReady(void);
 
+  uint32_t getCycleTime(void);
+  uint32_t nextSampleAt(void);
+  uint32_t msUntilNextSample(void);
+  bool calibrateCycleTime(uint32_t span_ms = 2000);
+
+  bool getEstimate(uint32_t at, tmp117_estimate_t *estimate);
+  void setEstimatorGains(float alpha, float beta);
+  void resetEstimator(void);
+
+  bool saveState(tmp117_state_t *state);
+  bool restoreState(const tmp117_state_t *state);
+  bool verifyState(const tmp117_state_t *state);
+
 protected:
   virtual bool _init(int32_t sensor_id);
   uint16_t _sensorid_temp; ///< ID number for temperature
@@ -187,7 +247,36 @@ private:
       alert_drdy_flags; ///< Storage for self-cleared bits in config reg.
   float unscaled_temp;  ///< Last reading's temperature (C) before scaling
 
+  tmp117_average_count_t _average_count =
+      TMP117_AVERAGE_8X; ///< Last written averaging setting
+  tmp117_delay_t _read_delay =
+      TMP117_DELAY_1000_MS;                     ///< Last written delay setting
+  tmp117_mode_t _mode = TMP117_MODE_CONTINUOUS; ///< Last written mode
+  uint32_t _sample_anchor = 0; ///< micros() of the last DRDY or mode change
+  bool _anchor_is_drdy = false; ///< True if `_sample_anchor` was a DRDY
+  uint32_t _last_miss = 0; ///< micros() of the last poll without DRDY
+  float _osc_scale = 1.0;       ///< Measured / nominal cycle time
+  bool _new_data = false;       ///< DRDY seen but new reading not yet fetched
+  uint32_t _drdy_time = 0;      ///< micros() of the last conversion seen
+
+  float _est_alpha = 0.5;     ///< Estimator temperature gain
+  float _est_beta = 0.1;      ///< Estimator slope gain
+  uint8_t _est_samples = 0;   ///< Readings used, saturates at 3
+  uint32_t _est_time = 0;     ///< micros() of the last reading used
+  uint32_t _est_interval = 0; ///< us between the last two readings used
+  float _est_temperature = 0; ///< Filtered temperature at `_est_time`
+  float _est_slope = 0;       ///< Filtered slope in degrees C per second
+  float _est_error = 0;       ///< Running mean of the absolute residual
+
+  void updateEstimator(uint32_t t, float temperature);
+
+  uint32_t nominalCycleTime(bool active_only);
+  void cacheSettings(uint16_t config);
+  void startSchedule(void);
+  void trackSample(uint32_t seen_us);
+
   void readAlertsDRDY(void);
+  void storeAlertsDRDY(uint8_t alert_bits);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+/**
+ * @file smbus_alert.ino
+ * @author Adafruit Industries
+ * @brief Find which of several TMP117/TMP119 sensors sharing one ALERT line
+ * triggered, using the SMBus Alert Response Address
+ *
+ * @copyright Copyright (c) 2020
+ *
+ */
+#include <Adafruit_Sensor.h>
+#include <Adafruit_TMP117.h>
+#include <Wire.h>
+
+// All ALERT pins are wired together to this pin, with a pullup
+#define ALERT_PIN 2
+
+Adafruit_TMP117 tmp_a;
+Adafruit_TMP117 tmp_b;
+Adafruit_TMP117 *sensors[] = {&tmp_a, &tmp_b};
+
+void setup(void) {
+  Serial.begin(115200);
+  while (!Serial)
+    delay(10); // will pause Zero, Leonardo, etc until serial console opens
+  Serial.println("Adafruit TMP117 SMBus alert test!");
+
+  if (!tmp_a.begin(0x48) || !tmp_b.begin(0x49)) {
+    Serial.println("Failed to find both TMP117 chips");
+    while (1) {
+      delay(10);
+    }
+  }
+  Serial.println("TMP117s Found!");
+
+  // You may need to adjust these thresholds to fit the temperature range of
+  // where the test is being run to be able to see the alerts trigger.
+  for (uint8_t i = 0; i < 2; i++) {
+    sensors[i]->setHighThreshold(30.0);
+    sensors[i]->setLowThreshold(20.0);
+  }
+
+  pinMode(ALERT_PIN, INPUT_PULLUP);
+}
+
+void loop() {
+  tmp117_alerts_t alerts;
+  Adafruit_TMP117 *alerting;
+  uint8_t address;
+
+  // ALERT is active low by default. Each response releases one device, so
+  // keep asking until every device asserting the line has been handled
+  while (digitalRead(ALERT_PIN) == LOW &&
+         Adafruit_TMP117::getAlertingSensor(sensors, 2, &alerting, &address,
+                                            &alerts)) {
+    if (alerting) {
+      Serial.print("Alert from sensor at 0x");
+    } else {
+      Serial.print("Alert from unknown device at 0x");
+    }
+    Serial.print(address, HEX);
+    Serial.print(" High: ");
+    Serial.print(alerts.high ? "True" : "False");
+    Serial.print(" Low: ");
+    Serial.println(alerts.low ? "True" : "False");
+  }
+  delay(10);
+}